@@ -2,17 +2,58 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/System.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <cstdlib>
 #include <ctime>
 #include <memory>
 #include <string>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 // Constants
 const unsigned int WINDOW_WIDTH = 800;
 const unsigned int WINDOW_HEIGHT = 600;
 const float PI = 3.14159265f;
 
+// Large World
+const float WORLD_WIDTH = WINDOW_WIDTH * 1024.f; // sized so LARGE_WORLD_ENEMY_COUNT is about one per screen
+const float WORLD_HEIGHT = WINDOW_HEIGHT * 1024.f;
+const float CHUNK_SIZE = 1024.f;
+const float ENEMY_MARGIN = 40.f; // largest enemy half-extent, boss health bar included
+const int LARGE_WORLD_ENEMY_COUNT = 1000000; // enemies seeded across the world at start
+const float RING_DRIFT_SPEED = 1.5f; // pixels per frame the ring travels through the world
+
+// Metrics
+const char* const METRICS_FILE = "metrics.txt"; // OpenMetrics snapshots, appended
+const int METRICS_FLUSH_SECONDS = 10;
+
+// Score Store
+const char* const SCORES_LOG_FILE = "scores.log"; // append-only results
+const char* const SCORES_INDEX_FILE = "scores.idx"; // per-difficulty sorted index
+const int SCORE_COMPACT_THRESHOLD = 256; // unindexed records before the index is rewritten
+const int LEADERBOARD_SIZE = 5;
+
 // Colors
 const sf::Color COLOR_WHITE = sf::Color::White;
 const sf::Color COLOR_BLUE = sf::Color::Blue;
@@ -27,6 +68,9 @@ enum class GameState { MENU, PLAY, GAME_OVER };
 // Difficulty Levels
 enum class Difficulty { EASY = 1, MEDIUM = 2, HARD = 3 };
 
+// Enemy Types
+enum class EnemyType { SQUARE, CIRCLE, BOSS };
+
 // Utility Functions
 float degToRad(float degrees) {
     return degrees * PI / 180.f;
@@ -38,6 +82,602 @@ sf::Vector2f calculatePosition(float angleDeg, float radius, sf::Vector2f center
                         center.y + radius * std::sin(angleRad));
 }
 
+// Uniform in [0, 1), fine enough for world coordinates even where RAND_MAX is 32767
+double randomFraction() {
+    double scale = RAND_MAX + 1.0;
+    return (rand() * scale + rand()) / (scale * scale);
+}
+
+// Metrics
+// Recording is a relaxed atomic add on the game thread; a background thread
+// reads the values and appends them to METRICS_FILE.
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// HDR-style histogram: each power of two is split into SUB_BUCKETS linear
+// buckets, so any value is kept within ~3% of its true size.
+class Histogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount(int index) const { return counts[index].load(std::memory_order_relaxed); }
+
+    uint64_t getSum() const { return sum.load(std::memory_order_relaxed); }
+
+    // Largest value that lands in bucket index
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SUB_BUCKETS) return index;
+        int group = index / SUB_BUCKETS;
+        uint64_t sub = index % SUB_BUCKETS;
+        uint64_t lower = (SUB_BUCKETS + sub) << (group - 1);
+        return lower + ((uint64_t(1) << (group - 1)) - 1);
+    }
+
+private:
+    static int highestBit(uint64_t value) {
+        int bit = 0;
+        for (int step = 32; step > 0; step /= 2) {
+            if (value >> step) {
+                value >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    static int bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<int>(value);
+        int shift = highestBit(value) - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+    }
+
+    std::atomic<uint64_t> counts[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> sum{0};
+};
+
+struct Metrics {
+    Histogram frameTimeUs;
+    Histogram tickTimeUs;
+    Histogram enemies;
+    Histogram bullets;
+    Histogram explosions;
+    Histogram collisionsPerTick;
+    Counter spawns;
+};
+
+Metrics metrics;
+
+// Appends an OpenMetrics snapshot of metrics every METRICS_FLUSH_SECONDS and
+// once more on shutdown
+class MetricsFlusher {
+public:
+    MetricsFlusher(const std::string& path) :
+        file(path, std::ios::app),
+        session(static_cast<long long>(std::time(nullptr))),
+        lastSpawns(0),
+        lastFlush(std::chrono::steady_clock::now()),
+        stopping(false),
+        worker(&MetricsFlusher::run, this) {
+    }
+
+    ~MetricsFlusher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    MetricsFlusher(const MetricsFlusher&) = delete;
+    MetricsFlusher& operator=(const MetricsFlusher&) = delete;
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::seconds(METRICS_FLUSH_SECONDS), [this] { return stopping; });
+            flush();
+        }
+    }
+
+    void flush() {
+        if (!file) return;
+        long long timestamp = static_cast<long long>(std::time(nullptr));
+        writeHistogram("frame_time_us", metrics.frameTimeUs, timestamp);
+        writeHistogram("tick_time_us", metrics.tickTimeUs, timestamp);
+        writeHistogram("enemies", metrics.enemies, timestamp);
+        writeHistogram("bullets", metrics.bullets, timestamp);
+        writeHistogram("explosions", metrics.explosions, timestamp);
+        writeHistogram("collisions_per_tick", metrics.collisionsPerTick, timestamp);
+
+        uint64_t spawns = metrics.spawns.get();
+        auto now = std::chrono::steady_clock::now();
+        double minutes = std::chrono::duration<double>(now - lastFlush).count() / 60.0;
+        double spawnsPerMinute = minutes > 0.0 ? (spawns - lastSpawns) / minutes : 0.0;
+        lastSpawns = spawns;
+        lastFlush = now;
+
+        file << "# TYPE circle_shooter_enemy_spawns counter\n";
+        file << "circle_shooter_enemy_spawns_total" << labels() << " " << spawns << " " << timestamp << "\n";
+        file << "# TYPE circle_shooter_enemy_spawns_per_minute gauge\n";
+        file << "circle_shooter_enemy_spawns_per_minute" << labels() << " " << spawnsPerMinute << " " << timestamp << "\n";
+        file << "# EOF\n";
+        file.flush();
+    }
+
+    // Cumulative buckets; empty ones are skipped to keep snapshots small
+    void writeHistogram(const std::string& name, const Histogram& histogram, long long timestamp) {
+        std::string metric = "circle_shooter_" + name;
+        file << "# TYPE " << metric << " histogram\n";
+        uint64_t cumulative = 0;
+        for (int i = 0; i < Histogram::BUCKET_COUNT; i++) {
+            uint64_t count = histogram.getCount(i);
+            if (count == 0) continue;
+            cumulative += count;
+            file << metric << "_bucket" << labels("le=\"" + std::to_string(Histogram::bucketUpperBound(i)) + "\"")
+                 << " " << cumulative << " " << timestamp << "\n";
+        }
+        file << metric << "_bucket" << labels("le=\"+Inf\"") << " " << cumulative << " " << timestamp << "\n";
+        file << metric << "_count" << labels() << " " << cumulative << " " << timestamp << "\n";
+        file << metric << "_sum" << labels() << " " << histogram.getSum() << " " << timestamp << "\n";
+    }
+
+    std::string labels(const std::string& extra = "") const {
+        std::string result = "{session=\"" + std::to_string(session) + "\"";
+        if (!extra.empty()) result += "," + extra;
+        return result + "}";
+    }
+
+    std::ofstream file;
+    long long session; // start time, tells sessions apart in the shared file
+    uint64_t lastSpawns;
+    std::chrono::steady_clock::time_point lastFlush;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker; // last, so everything above is ready when it starts
+};
+
+// Score Store
+// Results are appended to SCORES_LOG_FILE as fixed-size checksummed records.
+// SCORES_INDEX_FILE holds each difficulty's records sorted by score and covers
+// a prefix of the log; newer records are replayed from the log on load.
+// Writes, fsyncs and index rewrites all happen on a background thread.
+
+struct ScoreRecord {
+    int64_t timestamp; // unix seconds
+    int32_t score;
+    uint32_t durationMs;
+    uint32_t seed;
+    uint8_t difficulty;
+    uint8_t padding[7];
+    uint32_t checksum; // over every field above
+};
+static_assert(sizeof(ScoreRecord) == 32, "ScoreRecord is an on-disk format");
+
+struct ScoreIndexHeader {
+    uint32_t magic;
+    uint32_t recordCount; // log records covered by the index
+    uint32_t counts[3]; // entries per difficulty, EASY first
+    uint32_t checksum; // over the fields above, then the entries
+};
+
+struct ScoreIndexEntry {
+    int32_t score;
+    uint32_t record; // position in the log
+};
+
+const uint32_t SCORE_INDEX_MAGIC = 0x58444953; // "SIDX"
+
+// FNV-1a; pass a previous result as hash to continue over several buffers
+uint32_t checksum(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Read-only memory map of a whole file; empty if it is missing or zero-length.
+// failed() tells a file that exists but could not be read apart from those.
+class MappedFile {
+public:
+    MappedFile(const std::string& path) : bytes(nullptr), length(0), error(false) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        mapping = nullptr;
+        if (file == INVALID_HANDLE_VALUE) {
+            DWORD code = GetLastError();
+            error = code != ERROR_FILE_NOT_FOUND && code != ERROR_PATH_NOT_FOUND;
+            return;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            error = true;
+            return;
+        }
+        if (fileSize.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (bytes) length = static_cast<size_t>(fileSize.QuadPart);
+        else error = true;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = errno != ENOENT;
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            error = true;
+        }
+        else if (info.st_size > 0) {
+            void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                bytes = static_cast<const char*>(mapped);
+                length = static_cast<size_t>(info.st_size);
+            }
+            else {
+                error = true;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+
+    size_t size() const { return length; }
+
+    bool failed() const { return error; }
+
+private:
+    const char* bytes;
+    size_t length;
+    bool error;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// Flushes file all the way to disk
+bool syncFile(FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Seeks to a byte offset past what a 32-bit long can hold
+bool seekFile(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+// Cuts file down to size bytes, all the way to disk
+bool truncateFile(FILE* file, uint64_t size) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    if (_chsize_s(_fileno(file), static_cast<__int64>(size)) != 0) return false;
+#else
+    if (ftruncate(fileno(file), static_cast<off_t>(size)) != 0) return false;
+#endif
+    return syncFile(file);
+}
+
+// Atomically replaces to with from
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+class ScoreStore {
+public:
+    ScoreStore(const std::string& logPath, const std::string& indexPath) :
+        logPath(logPath),
+        indexPath(indexPath),
+        recordCount(0),
+        log(nullptr),
+        indexedCount(0),
+        stopping(false) {
+        log = load();
+        worker = std::thread(&ScoreStore::run, this);
+    }
+
+    ~ScoreStore() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        if (log) std::fclose(log);
+    }
+
+    ScoreStore(const ScoreStore&) = delete;
+    ScoreStore& operator=(const ScoreStore&) = delete;
+
+    // Queues the result for writing and returns its 1-based rank within its difficulty
+    int add(int score, Difficulty difficulty, uint32_t durationMs, uint32_t seed) {
+        ScoreRecord record = {};
+        record.timestamp = static_cast<int64_t>(std::time(nullptr));
+        record.score = score;
+        record.durationMs = durationMs;
+        record.seed = seed;
+        record.difficulty = static_cast<uint8_t>(difficulty);
+        record.checksum = checksum(&record, offsetof(ScoreRecord, checksum));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        int rank = 1 + countAbove(*entries[slot(difficulty)], score);
+        for (const auto& queued : pending) {
+            if (queued.difficulty == record.difficulty && queued.score > score) rank++;
+        }
+        pending.push_back(record);
+        wake.notify_one();
+        return rank;
+    }
+
+    // Best count (at most LEADERBOARD_SIZE) results for difficulty, highest
+    // first. Served from memory, so it never waits on the disk.
+    std::vector<ScoreRecord> top(Difficulty difficulty, int count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<ScoreRecord> result = best[slot(difficulty)];
+        for (const auto& queued : pending) {
+            if (queued.difficulty == static_cast<uint8_t>(difficulty)) result.push_back(queued);
+        }
+        std::stable_sort(result.begin(), result.end(),
+                         [](const ScoreRecord& a, const ScoreRecord& b) { return a.score > b.score; });
+        if (static_cast<int>(result.size()) > count) result.resize(count);
+        return result;
+    }
+
+private:
+    static int slot(Difficulty difficulty) { return static_cast<int>(difficulty) - 1; }
+
+    static int slot(const ScoreRecord& record) { return record.difficulty - 1; }
+
+    static bool higher(const ScoreIndexEntry& a, const ScoreIndexEntry& b) {
+        return a.score > b.score || (a.score == b.score && a.record < b.record);
+    }
+
+    static int countAbove(const std::vector<ScoreIndexEntry>& sorted, int score) {
+        auto it = std::partition_point(sorted.begin(), sorted.end(),
+                                       [score](const ScoreIndexEntry& entry) { return entry.score > score; });
+        return static_cast<int>(it - sorted.begin());
+    }
+
+    static bool valid(const ScoreRecord& record) {
+        return record.difficulty >= 1 && record.difficulty <= 3 &&
+               record.checksum == checksum(&record, offsetof(ScoreRecord, checksum));
+    }
+
+    static ScoreRecord recordAt(const MappedFile& logMap, uint32_t index) {
+        ScoreRecord record;
+        std::memcpy(&record, logMap.data() + size_t(index) * sizeof(ScoreRecord), sizeof(ScoreRecord));
+        return record;
+    }
+
+    // Keeps record in best if it makes its difficulty's top LEADERBOARD_SIZE.
+    // Records arrive in log order, so ties rank after the ones already there.
+    void keepBest(const ScoreRecord& record) {
+        auto& kept = best[slot(record)];
+        auto it = std::upper_bound(kept.begin(), kept.end(), record,
+                                   [](const ScoreRecord& a, const ScoreRecord& b) { return a.score > b.score; });
+        if (it - kept.begin() >= LEADERBOARD_SIZE) return;
+        kept.insert(it, record);
+        if (static_cast<int>(kept.size()) > LEADERBOARD_SIZE) kept.pop_back();
+    }
+
+    // Builds entries from the index and the log, cuts off a torn or corrupt
+    // tail, and returns the log opened for appending after the last good record
+    FILE* load() {
+        uint64_t logBytes;
+        {
+            MappedFile logMap(logPath); // unmapped before the log is truncated
+            if (logMap.failed()) {
+                // Unreadable rather than new: keep results in memory only, so the
+                // existing log is never written over
+                for (int d = 0; d < 3; d++) {
+                    entries[d] = std::make_shared<const std::vector<ScoreIndexEntry>>();
+                }
+                return nullptr;
+            }
+            logBytes = logMap.size();
+            readEntries(logMap);
+        }
+
+        // Records after a bad one are dropped from the file too, or they would
+        // come back once later appends had overwritten only part of the gap.
+        // Only create the log if there was nothing to lose.
+        uint64_t goodBytes = uint64_t(recordCount) * sizeof(ScoreRecord);
+        FILE* file = std::fopen(logPath.c_str(), "r+b");
+        if (!file && logBytes == 0) file = std::fopen(logPath.c_str(), "w+b");
+        if (file && ((logBytes > goodBytes && !truncateFile(file, goodBytes)) || !seekFile(file, goodBytes))) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        return file;
+    }
+
+    // Fills entries and best from the index and the log tail it does not
+    // cover, stopping at the first bad record
+    void readEntries(const MappedFile& logMap) {
+        std::vector<ScoreIndexEntry> loaded[3];
+        uint32_t logRecords = static_cast<uint32_t>(logMap.size() / sizeof(ScoreRecord));
+
+        MappedFile index(indexPath);
+        ScoreIndexHeader header;
+        if (index.size() >= sizeof(header)) {
+            std::memcpy(&header, index.data(), sizeof(header));
+            size_t total = size_t(header.counts[0]) + header.counts[1] + header.counts[2];
+            size_t bytes = total * sizeof(ScoreIndexEntry);
+            if (header.magic == SCORE_INDEX_MAGIC && header.recordCount <= logRecords &&
+                total == header.recordCount && index.size() == sizeof(header) + bytes &&
+                header.checksum == checksum(index.data() + sizeof(header), bytes,
+                                            checksum(&header, offsetof(ScoreIndexHeader, checksum)))) {
+                const char* cursor = index.data() + sizeof(header);
+                for (int d = 0; d < 3; d++) {
+                    loaded[d].resize(header.counts[d]);
+                    std::memcpy(loaded[d].data(), cursor, header.counts[d] * sizeof(ScoreIndexEntry));
+                    cursor += header.counts[d] * sizeof(ScoreIndexEntry);
+                }
+                indexedCount = header.recordCount;
+            }
+        }
+
+        // Replay the unindexed tail, stopping at the first bad record
+        recordCount = indexedCount;
+        size_t sortedSize[3] = { loaded[0].size(), loaded[1].size(), loaded[2].size() };
+        for (uint32_t i = indexedCount; i < logRecords; i++) {
+            ScoreRecord record = recordAt(logMap, i);
+            if (!valid(record)) break;
+            loaded[slot(record)].push_back(ScoreIndexEntry{ record.score, i });
+            recordCount = i + 1;
+        }
+        for (int d = 0; d < 3; d++) {
+            auto middle = loaded[d].begin() + sortedSize[d];
+            std::sort(middle, loaded[d].end(), higher);
+            std::inplace_merge(loaded[d].begin(), middle, loaded[d].end(), higher);
+            for (size_t i = 0; i < loaded[d].size() && static_cast<int>(i) < LEADERBOARD_SIZE; i++) {
+                best[d].push_back(recordAt(logMap, loaded[d][i].record));
+            }
+            entries[d] = std::make_shared<const std::vector<ScoreIndexEntry>>(std::move(loaded[d]));
+        }
+    }
+
+    // Only this thread replaces entries, so it can read them without the lock
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            // Also saves an index rebuilt on load, and whatever is left on shutdown
+            bool finishing = stopping && pending.empty();
+            if (log && recordCount != indexedCount &&
+                (recordCount - indexedCount >= static_cast<uint32_t>(SCORE_COMPACT_THRESHOLD) || finishing)) {
+                compact(lock);
+            }
+            if (finishing) break;
+
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) continue;
+
+            std::vector<ScoreRecord> batch = pending;
+            uint32_t firstIndex = recordCount;
+            lock.unlock();
+            if (log && (std::fwrite(batch.data(), sizeof(ScoreRecord), batch.size(), log) != batch.size() ||
+                        !syncFile(log))) {
+                // Stop persisting rather than leave the log and index out of step
+                std::fclose(log);
+                log = nullptr;
+            }
+
+            // Copy-on-write: queries keep reading the old vectors meanwhile
+            std::shared_ptr<std::vector<ScoreIndexEntry>> updated[3];
+            for (size_t i = 0; i < batch.size(); i++) {
+                int d = slot(batch[i]);
+                if (!updated[d]) updated[d] = std::make_shared<std::vector<ScoreIndexEntry>>(*entries[d]);
+                ScoreIndexEntry entry{ batch[i].score, firstIndex + static_cast<uint32_t>(i) };
+                updated[d]->insert(std::upper_bound(updated[d]->begin(), updated[d]->end(), entry, higher), entry);
+            }
+            lock.lock();
+
+            for (int d = 0; d < 3; d++) {
+                if (updated[d]) entries[d] = std::move(updated[d]);
+            }
+            for (const auto& record : batch) {
+                keepBest(record);
+            }
+            recordCount += static_cast<uint32_t>(batch.size());
+            pending.erase(pending.begin(), pending.begin() + batch.size());
+        }
+    }
+
+    // Rewrites the index to cover the whole log; the new file replaces the old
+    // one only once it is fully on disk
+    void compact(std::unique_lock<std::mutex>& lock) {
+        ScoreIndexHeader header = {};
+        header.magic = SCORE_INDEX_MAGIC;
+        header.recordCount = recordCount;
+        std::shared_ptr<const std::vector<ScoreIndexEntry>> snapshot[3];
+        for (int d = 0; d < 3; d++) {
+            snapshot[d] = entries[d];
+            header.counts[d] = static_cast<uint32_t>(snapshot[d]->size());
+        }
+        lock.unlock();
+
+        header.checksum = checksum(&header, offsetof(ScoreIndexHeader, checksum));
+        for (int d = 0; d < 3; d++) {
+            header.checksum = checksum(snapshot[d]->data(), snapshot[d]->size() * sizeof(ScoreIndexEntry), header.checksum);
+        }
+        std::string tempPath = indexPath + ".tmp";
+        bool written = false;
+        if (FILE* file = std::fopen(tempPath.c_str(), "wb")) {
+            written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+            for (int d = 0; d < 3; d++) {
+                written = written &&
+                          std::fwrite(snapshot[d]->data(), sizeof(ScoreIndexEntry), snapshot[d]->size(), file) == snapshot[d]->size();
+            }
+            written = written && syncFile(file);
+            std::fclose(file);
+        }
+        written = written && replaceFile(tempPath, indexPath);
+
+        lock.lock();
+        if (written) indexedCount = header.recordCount;
+    }
+
+    std::string logPath;
+    std::string indexPath;
+    uint32_t recordCount; // good records in the log, queued ones not included
+    FILE* log;
+    uint32_t indexedCount; // records covered by the index on disk
+    std::shared_ptr<const std::vector<ScoreIndexEntry>> entries[3]; // per difficulty, highest score first
+    std::vector<ScoreRecord> best[3]; // per difficulty, top LEADERBOARD_SIZE records, highest first
+    std::vector<ScoreRecord> pending; // queued, not yet written
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+};
+
 // Classes
 
 // Player Class
@@ -70,6 +710,14 @@ public:
 
     float getAngle() const { return angle; }
 
+    // Moves the ring the player circles around
+    void setCenter(sf::Vector2f value) {
+        center = value;
+        updatePosition();
+    }
+
+    sf::Vector2f getPosition() const { return position; }
+
 private:
     void updatePosition() {
         position = calculatePosition(angle, ringRadius, center);
@@ -124,6 +772,10 @@ public:
                 position.y < 0 || position.y > height);
     }
 
+    bool isOutside(const sf::FloatRect& area) const {
+        return !area.contains(position);
+    }
+
     sf::FloatRect getBounds() const {
         return shape.getGlobalBounds();
     }
@@ -239,7 +891,7 @@ private:
 class BossEnemy : public Enemy {
 public:
     BossEnemy(sf::Vector2f pos, sf::Vector2f vel, float size, sf::Color color) :
-        Enemy(pos, vel, size, color), health(10) {
+        Enemy(pos, vel, size, color), health(maxHealth) {
         shape.setSize(sf::Vector2f(size, size));
         shape.setFillColor(color);
         shape.setOrigin(size / 2.f, size / 2.f);
@@ -255,15 +907,24 @@ public:
 
     bool alive() const { return isAlive; }
 
+    int getHealth() const { return health; }
+
+    void setHealth(int value) {
+        health = value;
+        isAlive = health > 0;
+    }
+
     bool isBoss() const override { return true; }
 
+    static const int maxHealth = 10;
+
     void draw(sf::RenderWindow& window) override {
         // Draw health bar
         sf::RectangleShape healthBarBack(sf::Vector2f(size, 5.f));
         healthBarBack.setFillColor(sf::Color::Red);
         healthBarBack.setPosition(position.x - size / 2.f, position.y - size / 2.f - 10.f);
 
-        sf::RectangleShape healthBarFront(sf::Vector2f(size * (health / 10.f), 5.f));
+        sf::RectangleShape healthBarFront(sf::Vector2f(size * (health / static_cast<float>(maxHealth)), 5.f));
         healthBarFront.setFillColor(sf::Color::Green);
         healthBarFront.setPosition(position.x - size / 2.f, position.y - size / 2.f - 10.f);
 
@@ -282,12 +943,419 @@ std::unique_ptr<Bullet> Player::shoot() {
     return std::make_unique<Bullet>(position, angle);
 }
 
+// Enemy Factory
+float enemySize(EnemyType type) {
+    switch (type) {
+        case EnemyType::SQUARE: return 30.f;
+        case EnemyType::CIRCLE: return 25.f;
+        case EnemyType::BOSS: return 60.f;
+    }
+    return 0.f;
+}
+
+std::unique_ptr<Enemy> makeEnemy(EnemyType type, sf::Vector2f pos, sf::Vector2f vel) {
+    switch (type) {
+        case EnemyType::SQUARE: return std::make_unique<Enemy>(pos, vel, enemySize(type), COLOR_RED);
+        case EnemyType::CIRCLE: return std::make_unique<CircleEnemy>(pos, vel, enemySize(type), COLOR_RED);
+        case EnemyType::BOSS: return std::make_unique<BossEnemy>(pos, vel, enemySize(type), COLOR_YELLOW);
+    }
+    return nullptr;
+}
+
+// World Class
+// Partitions the large arena into CHUNK_SIZE squares. Enemies here are plain
+// data: they move in straight lines, so each keeps its position at the frame
+// it was last touched and is only stepped when it matters. Chunks near the
+// player bring their enemies up to date every frame. A far enemy is only
+// looked at when it leaves its chunk, or, while it is still more than a chunk
+// from the near area, when it could first get that close; until then it may
+// stay listed in a chunk it has moved out of. Drawing repositions one shape
+// per enemy type; a full Enemy is only built for a bullet hit.
+class World {
+public:
+    // maxFocusSpeed bounds how far the near area can move per frame
+    World(sf::FloatRect bounds, float maxFocusSpeed) :
+        bounds(bounds), maxFocusSpeed(maxFocusSpeed), frame(0), enemyCount(0) {
+        cols = static_cast<int>(std::ceil(bounds.width / CHUNK_SIZE));
+        rows = static_cast<int>(std::ceil(bounds.height / CHUNK_SIZE));
+        crossings.resize(CROSSING_WHEEL_SIZE);
+        resetNearRange();
+
+        // Same looks as Enemy, CircleEnemy and BossEnemy
+        float squareSize = enemySize(EnemyType::SQUARE);
+        squareShape.setSize(sf::Vector2f(squareSize, squareSize));
+        squareShape.setFillColor(COLOR_RED);
+        squareShape.setOrigin(squareSize / 2.f, squareSize / 2.f);
+
+        float circleSize = enemySize(EnemyType::CIRCLE);
+        circleShape.setRadius(circleSize / 2.f);
+        circleShape.setFillColor(COLOR_RED);
+        circleShape.setOrigin(circleSize / 2.f, circleSize / 2.f);
+
+        float bossSize = enemySize(EnemyType::BOSS);
+        bossShape.setSize(sf::Vector2f(bossSize, bossSize));
+        bossShape.setFillColor(COLOR_YELLOW);
+        bossShape.setOrigin(bossSize / 2.f, bossSize / 2.f);
+        healthBarBack.setSize(sf::Vector2f(bossSize, 5.f));
+        healthBarBack.setFillColor(sf::Color::Red);
+        healthBarFront.setFillColor(sf::Color::Green);
+    }
+
+    // Releases every enemy and the chunk table, not just the count, so a
+    // finished game doesn't hold on to memory
+    void clear() {
+        std::vector<Chunk>().swap(chunks);
+        std::vector<WorldEnemy>().swap(enemies);
+        for (auto& due : crossings) {
+            std::vector<uint32_t>().swap(due);
+        }
+        frame = 0;
+        enemyCount = 0;
+        resetNearRange();
+    }
+
+    void add(sf::Vector2f pos, sf::Vector2f vel, EnemyType type) {
+        int index = chunkIndex(pos);
+        if (index < 0) return; // Outside the world
+        WorldEnemy enemy;
+        enemy.position = pos;
+        enemy.velocity = vel;
+        enemy.type = type;
+        enemy.health = BossEnemy::maxHealth;
+        enemy.updated = frame;
+        enemies.push_back(enemy);
+        attach(static_cast<uint32_t>(enemies.size() - 1), index);
+        enemyCount++;
+    }
+
+    // Sets the area simulated every frame. Call before adding enemies, then
+    // keep it moving no faster than maxFocusSpeed.
+    void focus(const sf::FloatRect& area) {
+        if (chunks.empty()) chunks.resize(cols * rows);
+        nearArea = area;
+        updateNearRange();
+    }
+
+    // Returns true if an enemy reached the ring. The ring must lie inside nearArea.
+    bool update(const sf::FloatRect& area, sf::Vector2f ringCenter, float reachRadius) {
+        frame++;
+        focus(area);
+
+        // Far enemies due to be looked at. Rescheduling always lands on a
+        // later frame, so this slot is not appended to while it is walked.
+        auto& due = crossings[frame % CROSSING_WHEEL_SIZE];
+        for (uint32_t id : due) {
+            WorldEnemy& enemy = enemies[id];
+            if (!enemy.alive || enemy.crossing != frame || chunks[enemy.chunk].isNear) continue; // Stale
+            catchUp(enemy);
+            relocate(id);
+        }
+        due.clear();
+
+        bool reached = false;
+        for (int row = nearFirstRow; row <= nearLastRow; row++) {
+            for (int col = nearFirstCol; col <= nearLastCol; col++) {
+                int index = row * cols + col;
+                auto& ids = chunks[index].ids;
+                for (size_t i = 0; i < ids.size(); ) {
+                    WorldEnemy& enemy = enemies[ids[i]];
+                    catchUp(enemy);
+
+                    sf::Vector2f offset = enemy.position - ringCenter;
+                    if (std::sqrt(offset.x * offset.x + offset.y * offset.y) <= reachRadius) {
+                        reached = true;
+                    }
+
+                    // Moving out swaps another enemy into slot i
+                    if (chunkIndex(enemy.position) != index) {
+                        relocate(ids[i]);
+                    }
+                    else {
+                        ++i;
+                    }
+                }
+            }
+        }
+        return reached;
+    }
+
+    // Tests each bullet against the enemies around it. onHit gets a temporary
+    // Enemy and returns true if it was destroyed.
+    template <typename OnHit>
+    void collide(std::vector<std::unique_ptr<Bullet>>& bullets, OnHit onHit) {
+        for (auto bulletIt = bullets.begin(); bulletIt != bullets.end(); ) {
+            if (hitNearby(**bulletIt, onHit)) {
+                bulletIt = bullets.erase(bulletIt);
+            }
+            else {
+                ++bulletIt;
+            }
+        }
+    }
+
+    void draw(sf::RenderWindow& window, const sf::FloatRect& viewArea) {
+        // Pad so enemies centred just outside the view still draw their overlap
+        int firstCol, firstRow, lastCol, lastRow;
+        chunkRange(inflate(viewArea, ENEMY_MARGIN), firstCol, firstRow, lastCol, lastRow);
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int col = firstCol; col <= lastCol; col++) {
+                for (uint32_t id : chunks[row * cols + col].ids) {
+                    catchUp(enemies[id]);
+                    drawEnemy(window, enemies[id]);
+                }
+            }
+        }
+    }
+
+    sf::FloatRect getBounds() const { return bounds; }
+
+    int size() const { return enemyCount; }
+
+private:
+    struct WorldEnemy {
+        sf::Vector2f position; // as of frame updated
+        sf::Vector2f velocity;
+        EnemyType type;
+        int health;
+        int updated = 0;
+        int crossing = 0; // frame it is next looked at while far
+        int chunk = -1;
+        uint32_t slot = 0; // position in the chunk's ids
+        bool alive = true;
+    };
+
+    struct Chunk {
+        std::vector<uint32_t> ids;
+        bool isNear = false;
+    };
+
+    // Frames covered by the crossing wheel; later ones are capped to it
+    static const int CROSSING_WHEEL_SIZE = 1024;
+
+    static sf::FloatRect inflate(const sf::FloatRect& area, float margin) {
+        return sf::FloatRect(area.left - margin, area.top - margin,
+                             area.width + 2.f * margin, area.height + 2.f * margin);
+    }
+
+    void catchUp(WorldEnemy& enemy) {
+        if (enemy.updated == frame) return;
+        enemy.position += enemy.velocity * static_cast<float>(frame - enemy.updated);
+        enemy.updated = frame;
+    }
+
+    void drawEnemy(sf::RenderWindow& window, const WorldEnemy& enemy) {
+        switch (enemy.type) {
+            case EnemyType::SQUARE:
+                squareShape.setPosition(enemy.position);
+                window.draw(squareShape);
+                break;
+            case EnemyType::CIRCLE:
+                circleShape.setPosition(enemy.position);
+                window.draw(circleShape);
+                break;
+            case EnemyType::BOSS: {
+                float size = enemySize(enemy.type);
+                sf::Vector2f barPosition(enemy.position.x - size / 2.f, enemy.position.y - size / 2.f - 10.f);
+                healthBarBack.setPosition(barPosition);
+                healthBarFront.setSize(sf::Vector2f(size * (enemy.health / static_cast<float>(BossEnemy::maxHealth)), 5.f));
+                healthBarFront.setPosition(barPosition);
+                bossShape.setPosition(enemy.position);
+                window.draw(bossShape);
+                window.draw(healthBarBack);
+                window.draw(healthBarFront);
+                break;
+            }
+        }
+    }
+
+    // For bullet hits, which go through Game::hitEnemy
+    std::unique_ptr<Enemy> build(const WorldEnemy& enemy) const {
+        std::unique_ptr<Enemy> shape = makeEnemy(enemy.type, enemy.position, enemy.velocity);
+        if (enemy.type == EnemyType::BOSS) {
+            static_cast<BossEnemy&>(*shape).setHealth(enemy.health);
+        }
+        return shape;
+    }
+
+    sf::FloatRect enemyBounds(const WorldEnemy& enemy) const {
+        float size = enemySize(enemy.type);
+        return sf::FloatRect(enemy.position.x - size / 2.f, enemy.position.y - size / 2.f, size, size);
+    }
+
+    int chunkIndex(sf::Vector2f pos) const {
+        int col = static_cast<int>(std::floor((pos.x - bounds.left) / CHUNK_SIZE));
+        int row = static_cast<int>(std::floor((pos.y - bounds.top) / CHUNK_SIZE));
+        if (col < 0 || col >= cols || row < 0 || row >= rows) return -1;
+        return row * cols + col;
+    }
+
+    sf::FloatRect chunkBounds(int index) const {
+        return sf::FloatRect(bounds.left + (index % cols) * CHUNK_SIZE,
+                             bounds.top + (index / cols) * CHUNK_SIZE,
+                             CHUNK_SIZE, CHUNK_SIZE);
+    }
+
+    // Clamped range of chunk columns/rows overlapping area
+    void chunkRange(const sf::FloatRect& area, int& firstCol, int& firstRow, int& lastCol, int& lastRow) const {
+        firstCol = std::max(0, static_cast<int>(std::floor((area.left - bounds.left) / CHUNK_SIZE)));
+        firstRow = std::max(0, static_cast<int>(std::floor((area.top - bounds.top) / CHUNK_SIZE)));
+        lastCol = std::min(cols - 1, static_cast<int>(std::floor((area.left + area.width - bounds.left) / CHUNK_SIZE)));
+        lastRow = std::min(rows - 1, static_cast<int>(std::floor((area.top + area.height - bounds.top) / CHUNK_SIZE)));
+    }
+
+    void resetNearRange() {
+        nearFirstCol = nearFirstRow = 0;
+        nearLastCol = nearLastRow = -1;
+    }
+
+    bool inNearRange(int index) const {
+        int col = index % cols;
+        int row = index / cols;
+        return col >= nearFirstCol && col <= nearLastCol && row >= nearFirstRow && row <= nearLastRow;
+    }
+
+    // Chunks that drop out of the near area hand their enemies to the crossing queue
+    void updateNearRange() {
+        int oldFirstCol = nearFirstCol, oldFirstRow = nearFirstRow;
+        int oldLastCol = nearLastCol, oldLastRow = nearLastRow;
+        chunkRange(nearArea, nearFirstCol, nearFirstRow, nearLastCol, nearLastRow);
+
+        for (int row = oldFirstRow; row <= oldLastRow; row++) {
+            for (int col = oldFirstCol; col <= oldLastCol; col++) {
+                int index = row * cols + col;
+                if (inNearRange(index)) continue;
+                chunks[index].isNear = false;
+                std::vector<uint32_t> leaving = chunks[index].ids; // relocate() edits the original
+                for (uint32_t id : leaving) {
+                    catchUp(enemies[id]);
+                    relocate(id);
+                }
+            }
+        }
+        for (int row = nearFirstRow; row <= nearLastRow; row++) {
+            for (int col = nearFirstCol; col <= nearLastCol; col++) {
+                chunks[row * cols + col].isNear = true;
+            }
+        }
+    }
+
+    // Frames until position leaves [low, high) moving at speed
+    static float stepsToLeave(float position, float speed, float low, float high) {
+        if (speed > 0.f) return (high - position) / speed;
+        if (speed < 0.f) return (low - position) / speed;
+        return static_cast<float>(CROSSING_WHEEL_SIZE);
+    }
+
+    // The later of leaving its chunk and coming within a chunk of the near
+    // area (which holds every chunk that can be near), for an up-to-date enemy
+    void schedule(uint32_t id) {
+        WorldEnemy& enemy = enemies[id];
+        sf::FloatRect area = chunkBounds(enemy.chunk);
+        float leave = std::min(stepsToLeave(enemy.position.x, enemy.velocity.x, area.left, area.left + area.width),
+                               stepsToLeave(enemy.position.y, enemy.velocity.y, area.top, area.top + area.height)) + 1.f;
+
+        sf::FloatRect zone = inflate(nearArea, CHUNK_SIZE);
+        float dx = std::max(std::max(zone.left - enemy.position.x, enemy.position.x - (zone.left + zone.width)), 0.f);
+        float dy = std::max(std::max(zone.top - enemy.position.y, enemy.position.y - (zone.top + zone.height)), 0.f);
+        float closing = std::sqrt(enemy.velocity.x * enemy.velocity.x + enemy.velocity.y * enemy.velocity.y) + maxFocusSpeed;
+        float approach = std::sqrt(dx * dx + dy * dy) / closing;
+
+        float steps = std::min(std::max(leave, approach), static_cast<float>(CROSSING_WHEEL_SIZE));
+        enemy.crossing = enemy.updated + static_cast<int>(steps);
+        enemy.crossing = std::min(std::max(enemy.crossing, frame + 1), frame + CROSSING_WHEEL_SIZE - 1);
+        crossings[enemy.crossing % CROSSING_WHEEL_SIZE].push_back(id);
+    }
+
+    void attach(uint32_t id, int index) {
+        WorldEnemy& enemy = enemies[id];
+        enemy.chunk = index;
+        enemy.slot = static_cast<uint32_t>(chunks[index].ids.size());
+        chunks[index].ids.push_back(id);
+        if (!chunks[index].isNear) {
+            schedule(id);
+        }
+    }
+
+    void detach(uint32_t id) {
+        WorldEnemy& enemy = enemies[id];
+        auto& ids = chunks[enemy.chunk].ids;
+        ids[enemy.slot] = ids.back();
+        enemies[ids.back()].slot = enemy.slot;
+        ids.pop_back();
+    }
+
+    void remove(uint32_t id) {
+        detach(id);
+        enemies[id].alive = false;
+        enemyCount--;
+    }
+
+    // Lists an up-to-date enemy under the chunk it is now in
+    void relocate(uint32_t id) {
+        int index = chunkIndex(enemies[id].position);
+        if (index == enemies[id].chunk) {
+            if (!chunks[index].isNear) schedule(id);
+            return;
+        }
+        if (index < 0) {
+            remove(id); // Left the world
+            return;
+        }
+        detach(id);
+        attach(id, index);
+    }
+
+    template <typename OnHit>
+    bool hitNearby(const Bullet& bullet, OnHit& onHit) {
+        sf::FloatRect bulletBounds = bullet.getBounds();
+        int firstCol, firstRow, lastCol, lastRow;
+        chunkRange(inflate(bulletBounds, ENEMY_MARGIN), firstCol, firstRow, lastCol, lastRow);
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int col = firstCol; col <= lastCol; col++) {
+                for (uint32_t id : chunks[row * cols + col].ids) {
+                    WorldEnemy& enemy = enemies[id];
+                    catchUp(enemy);
+                    if (!enemyBounds(enemy).intersects(bulletBounds)) continue;
+
+                    std::unique_ptr<Enemy> shape = build(enemy);
+                    if (onHit(*shape)) {
+                        remove(id);
+                    }
+                    else if (enemy.type == EnemyType::BOSS) {
+                        enemy.health = static_cast<BossEnemy&>(*shape).getHealth();
+                    }
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    sf::FloatRect bounds;
+    float maxFocusSpeed;
+    int cols;
+    int rows;
+    int frame;
+    int enemyCount;
+    sf::FloatRect nearArea;
+    int nearFirstCol, nearFirstRow, nearLastCol, nearLastRow;
+    std::vector<Chunk> chunks;
+    std::vector<WorldEnemy> enemies; // slots of removed enemies are not reused until clear()
+    std::vector<std::vector<uint32_t>> crossings; // enemy ids by crossing frame % CROSSING_WHEEL_SIZE
+    sf::RectangleShape squareShape;
+    sf::CircleShape circleShape;
+    sf::RectangleShape bossShape;
+    sf::RectangleShape healthBarBack;
+    sf::RectangleShape healthBarFront;
+};
+
 // EnemyManager Class
 class EnemyManager {
 public:
     EnemyManager(sf::Vector2f center, float ringRadius, Difficulty difficulty) :
         center(center), ringRadius(ringRadius), difficulty(difficulty) {
-        srand(static_cast<unsigned int>(time(0)));
+        seed = static_cast<unsigned int>(time(0));
+        srand(seed);
         spawnTimer = 0;
         spawnInterval = 60 / static_cast<int>(difficulty); // Lower difficulty, slower spawn
     }
@@ -296,61 +1364,133 @@ public:
         spawnTimer++;
         if (spawnTimer >= spawnInterval) {
             spawnTimer = 0;
-            spawnEnemy(enemies);
+            if (spawnEnemy(enemies)) {
+                metrics.spawns.add();
+            }
         }
     }
 
+    // Large world: spawns just outside the view, heading for the ring's current centre
+    void update(float, World& world, const sf::FloatRect& viewArea, sf::Vector2f target) {
+        spawnTimer++;
+        if (spawnTimer >= spawnInterval) {
+            spawnTimer = 0;
+            if (spawnEnemy(world, viewArea, target)) {
+                metrics.spawns.add();
+            }
+        }
+    }
+
+    // Seeds count enemies anywhere in the world outside the excluded area.
+    // They wander in random directions rather than all closing on the ring.
+    void populate(World& world, const sf::FloatRect& exclude, int count) {
+        sf::FloatRect bounds = world.getBounds();
+        int added = 0;
+        while (added < count) {
+            sf::Vector2f pos;
+            do {
+                pos = sf::Vector2f(bounds.left + static_cast<float>(randomFraction() * bounds.width),
+                                   bounds.top + static_cast<float>(randomFraction() * bounds.height));
+            } while (exclude.contains(pos));
+
+            EnemyType type;
+            if (!rollType(type)) continue;
+            float heading = static_cast<float>(randomFraction() * 360.0);
+            world.add(pos, calculatePosition(heading, speed(), sf::Vector2f()), type);
+            added++;
+        }
+    }
+
+    unsigned int getSeed() const { return seed; }
+
 private:
-    void spawnEnemy(std::vector<std::unique_ptr<Enemy>>& enemies) {
+    // Returns true if an enemy was spawned
+    bool spawnEnemy(std::vector<std::unique_ptr<Enemy>>& enemies) {
+        sf::Vector2f pos = edgePosition(sf::FloatRect(0.f, 0.f, WINDOW_WIDTH, WINDOW_HEIGHT));
+        if (auto enemy = createEnemy(pos)) {
+            enemies.emplace_back(std::move(enemy));
+            return true;
+        }
+        return false;
+    }
+
+    bool spawnEnemy(World& world, const sf::FloatRect& viewArea, sf::Vector2f target) {
+        sf::Vector2f pos = edgePosition(viewArea);
+        EnemyType type;
+        if (!rollType(type)) return false;
+        world.add(pos, velocityTowards(pos, target), type);
+        return true;
+    }
+
+    // Just outside a random side of area
+    sf::Vector2f edgePosition(const sf::FloatRect& area) const {
         // Randomly choose spawn side
         int side = rand() % 4; // 0: top, 1: bottom, 2: left, 3: right
+        int width = static_cast<int>(area.width);
+        int height = static_cast<int>(area.height);
         sf::Vector2f pos;
-        sf::Vector2f vel;
-        float speed = 1.f + static_cast<int>(difficulty) * 0.5f;
 
         switch (side) {
             case 0: // Top
-                pos = sf::Vector2f(rand() % WINDOW_WIDTH, -30.f);
-                vel = sf::Vector2f(center.x - pos.x, center.y - pos.y);
+                pos = sf::Vector2f(area.left + rand() % width, area.top - 30.f);
                 break;
             case 1: // Bottom
-                pos = sf::Vector2f(rand() % WINDOW_WIDTH, WINDOW_HEIGHT + 30.f);
-                vel = sf::Vector2f(center.x - pos.x, center.y - pos.y);
+                pos = sf::Vector2f(area.left + rand() % width, area.top + area.height + 30.f);
                 break;
             case 2: // Left
-                pos = sf::Vector2f(-30.f, rand() % WINDOW_HEIGHT);
-                vel = sf::Vector2f(center.x - pos.x, center.y - pos.y);
+                pos = sf::Vector2f(area.left - 30.f, area.top + rand() % height);
                 break;
             case 3: // Right
-                pos = sf::Vector2f(WINDOW_WIDTH + 30.f, rand() % WINDOW_HEIGHT);
-                vel = sf::Vector2f(center.x - pos.x, center.y - pos.y);
+                pos = sf::Vector2f(area.left + area.width + 30.f, area.top + rand() % height);
                 break;
         }
+        return pos;
+    }
+
+    // Returns nullptr when the rolled type is not available on this difficulty
+    std::unique_ptr<Enemy> createEnemy(sf::Vector2f pos) {
+        EnemyType type;
+        if (!rollType(type)) return nullptr;
+        return makeEnemy(type, pos, velocityTowards(pos, center));
+    }
+
+    float speed() const {
+        return 1.f + static_cast<int>(difficulty) * 0.5f;
+    }
+
+    sf::Vector2f velocityTowards(sf::Vector2f pos, sf::Vector2f target) const {
+        sf::Vector2f vel(target.x - pos.x, target.y - pos.y);
 
         // Normalize velocity
         float length = std::sqrt(vel.x * vel.x + vel.y * vel.y);
         vel /= length;
-        vel *= speed;
+        vel *= speed();
+        return vel;
+    }
 
+    // Returns false when the roll lands on a type this difficulty doesn't have
+    bool rollType(EnemyType& type) {
         // Randomly decide enemy type
-        int type = rand() % (3 + (static_cast<int>(difficulty) >= 3 ? 1 : 0)); // More types on higher difficulty
-        if (type == 0) {
-            // Square Enemy
-            enemies.emplace_back(std::make_unique<Enemy>(pos, vel, 30.f, COLOR_RED));
+        int roll = rand() % (3 + (static_cast<int>(difficulty) >= 3 ? 1 : 0)); // More types on higher difficulty
+        if (roll == 0) {
+            type = EnemyType::SQUARE;
+        }
+        else if (roll == 1) {
+            type = EnemyType::CIRCLE;
         }
-        else if (type == 1) {
-            // Circle Enemy
-            enemies.emplace_back(std::make_unique<CircleEnemy>(pos, vel, 25.f, COLOR_RED));
+        else if (roll == 2 && static_cast<int>(difficulty) >= 3) {
+            type = EnemyType::BOSS;
         }
-        else if (type == 2 && static_cast<int>(difficulty) >= 3) {
-            // Boss Enemy
-            enemies.emplace_back(std::make_unique<BossEnemy>(pos, vel, 60.f, COLOR_YELLOW));
+        else {
+            return false;
         }
+        return true;
     }
 
     sf::Vector2f center;
     float ringRadius;
     Difficulty difficulty;
+    unsigned int seed;
     int spawnTimer;
     int spawnInterval;
 };
@@ -377,10 +1517,17 @@ public:
     }
 
     void run() {
+        sf::Clock frameClock;
         while (window.isOpen()) {
             handleEvents();
+            bool playing = state == GameState::PLAY;
+            sf::Clock tickClock;
             update();
+            if (playing) {
+                metrics.tickTimeUs.record(static_cast<uint64_t>(tickClock.getElapsedTime().asMicroseconds()));
+            }
             render();
+            metrics.frameTimeUs.record(static_cast<uint64_t>(frameClock.restart().asMicroseconds()));
         }
     }
 
@@ -405,6 +1552,15 @@ private:
     std::vector<std::unique_ptr<Bullet>> bullets;
     std::vector<std::unique_ptr<Explosion>> explosions;
 
+    // Large World (the ring starts at its centre and drifts; the camera follows the ring)
+    bool largeWorld = false;
+    World world = World(sf::FloatRect(center.x - WORLD_WIDTH / 2.f, center.y - WORLD_HEIGHT / 2.f,
+                                      WORLD_WIDTH, WORLD_HEIGHT),
+                        RING_DRIFT_SPEED);
+    sf::Vector2f ringCenter = center;
+    sf::Vector2f ringVelocity;
+    sf::View camera = sf::View(sf::FloatRect(0.f, 0.f, WINDOW_WIDTH, WINDOW_HEIGHT));
+
     // Menu
     sf::Font font;
     int difficultyIndex = 0;
@@ -412,6 +1568,14 @@ private:
 
     // Game Over
     int score;
+    sf::Clock playClock;
+    ScoreStore scoreStore{SCORES_LOG_FILE, SCORES_INDEX_FILE};
+    int rank = 0;
+    std::vector<ScoreRecord> leaderboard;
+
+    // Metrics
+    int collisionsThisTick = 0;
+    MetricsFlusher metricsFlusher{METRICS_FILE};
 
     // Screen Shake
     int shakeDuration;
@@ -433,8 +1597,22 @@ private:
                         enemies.clear();
                         bullets.clear();
                         explosions.clear();
+                        world.clear();
                         score = 0;
+                        playClock.restart();
                         enemyManager = EnemyManager(center, ringRadius, selectedDifficulty);
+                        ringCenter = center;
+                        playerInstance.setCenter(ringCenter);
+                        if (largeWorld) {
+                            float heading = static_cast<float>(randomFraction() * 360.0);
+                            ringVelocity = calculatePosition(heading, RING_DRIFT_SPEED, sf::Vector2f());
+                            camera.setCenter(ringCenter);
+                            world.focus(nearArea());
+                            enemyManager.populate(world, nearArea(), LARGE_WORLD_ENEMY_COUNT);
+                        }
+                    }
+                    else if (event.key.code == sf::Keyboard::W) {
+                        largeWorld = !largeWorld;
                     }
                     else if (event.key.code == sf::Keyboard::Up) {
                         difficultyIndex = (difficultyIndex - 1 + difficulties.size()) % difficulties.size();
@@ -480,79 +1658,17 @@ private:
 
     void update() {
         if (state == GameState::PLAY) {
+            collisionsThisTick = 0;
             playerInstance.update();
 
-            // Update bullets
-            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                (*it)->update();
-                if ((*it)->isOffScreen(WINDOW_WIDTH, WINDOW_HEIGHT)) {
-                    it = bullets.erase(it);
-                }
-                else {
-                    ++it;
-                }
+            if (largeWorld) {
+                updateWorld();
             }
-
-            // Update enemies
-            enemyManager.update(1.f / 60.f, enemies);
-            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                (*it)->update();
-
-                // Check if enemy reached the ring
-                float distance = std::sqrt(std::pow((*it)->getBounds().left + (*it)->getBounds().width / 2.f - center.x, 2) +
-                                           std::pow((*it)->getBounds().top + (*it)->getBounds().height / 2.f - center.y, 2));
-                if (distance <= ringRadius + 30.f) { // 30.f is arbitrary
-                    state = GameState::GAME_OVER;
-                }
-
-                // Remove if off-screen (optional)
-                if ((*it)->getBounds().left < -50.f || (*it)->getBounds().left > WINDOW_WIDTH + 50.f ||
-                    (*it)->getBounds().top < -50.f || (*it)->getBounds().top > WINDOW_HEIGHT + 50.f) {
-                    it = enemies.erase(it);
-                }
-                else {
-                    ++it;
-                }
+            else {
+                updateArena();
             }
-
-            // Check collisions
-            for (auto enemyIt = enemies.begin(); enemyIt != enemies.end(); ) {
-                bool enemyRemoved = false;
-                for (auto bulletIt = bullets.begin(); bulletIt != bullets.end(); ) {
-                    if ((*enemyIt)->getBounds().intersects((*bulletIt)->getBounds())) {
-                        // Create explosion
-                        explosions.emplace_back(std::make_unique<Explosion>((*enemyIt)->getBounds().getPosition() + sf::Vector2f((*enemyIt)->getBounds().width / 2.f, (*enemyIt)->getBounds().height / 2.f)));
-
-                        // Screen shake
-                        shakeDuration = 10;
-                        shakeMagnitude = 5.f;
-
-                        // Handle boss health
-                        BossEnemy* boss = dynamic_cast<BossEnemy*>(enemyIt->get());
-                        if (boss) {
-                            boss->takeDamage();
-                            if (!boss->alive()) {
-                                score += 5; // Boss gives more points
-                                enemyIt = enemies.erase(enemyIt);
-                                enemyRemoved = true;
-                            }
-                        }
-                        else {
-                            score += 1;
-                            enemyIt = enemies.erase(enemyIt);
-                            enemyRemoved = true;
-                        }
-
-                        bulletIt = bullets.erase(bulletIt);
-                        break;
-                    }
-                    else {
-                        ++bulletIt;
-                    }
-                }
-                if (!enemyRemoved) {
-                    ++enemyIt;
-                }
+            if (state == GameState::GAME_OVER) {
+                endGame();
             }
 
             // Update explosions
@@ -566,6 +1682,11 @@ private:
                 }
             }
 
+            metrics.enemies.record(enemies.size() + world.size());
+            metrics.bullets.record(bullets.size());
+            metrics.explosions.record(explosions.size());
+            metrics.collisionsPerTick.record(collisionsThisTick);
+
             // Update screen shake
             if (shakeDuration > 0) {
                 float offsetX = (std::rand() % static_cast<int>(shakeMagnitude * 2)) - shakeMagnitude;
@@ -580,6 +1701,148 @@ private:
         }
     }
 
+    void updateArena() {
+        // Update bullets
+        for (auto it = bullets.begin(); it != bullets.end(); ) {
+            (*it)->update();
+            if ((*it)->isOffScreen(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+                it = bullets.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        // Update enemies
+        enemyManager.update(1.f / 60.f, enemies);
+        for (auto it = enemies.begin(); it != enemies.end(); ) {
+            (*it)->update();
+
+            // Check if enemy reached the ring
+            float distance = std::sqrt(std::pow((*it)->getBounds().left + (*it)->getBounds().width / 2.f - center.x, 2) +
+                                       std::pow((*it)->getBounds().top + (*it)->getBounds().height / 2.f - center.y, 2));
+            if (distance <= ringRadius + 30.f) { // 30.f is arbitrary
+                state = GameState::GAME_OVER;
+            }
+
+            // Remove if off-screen (optional)
+            if ((*it)->getBounds().left < -50.f || (*it)->getBounds().left > WINDOW_WIDTH + 50.f ||
+                (*it)->getBounds().top < -50.f || (*it)->getBounds().top > WINDOW_HEIGHT + 50.f) {
+                it = enemies.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        // Check collisions
+        for (auto enemyIt = enemies.begin(); enemyIt != enemies.end(); ) {
+            bool enemyRemoved = false;
+            for (auto bulletIt = bullets.begin(); bulletIt != bullets.end(); ) {
+                if ((*enemyIt)->getBounds().intersects((*bulletIt)->getBounds())) {
+                    if (hitEnemy(**enemyIt)) {
+                        enemyIt = enemies.erase(enemyIt);
+                        enemyRemoved = true;
+                    }
+
+                    bulletIt = bullets.erase(bulletIt);
+                    break;
+                }
+                else {
+                    ++bulletIt;
+                }
+            }
+            if (!enemyRemoved) {
+                ++enemyIt;
+            }
+        }
+    }
+
+    void updateWorld() {
+        // Drift the ring, turning back before the view would leave the world
+        ringCenter += ringVelocity;
+        sf::FloatRect bounds = world.getBounds();
+        if (ringCenter.x < bounds.left + WINDOW_WIDTH / 2.f ||
+            ringCenter.x > bounds.left + bounds.width - WINDOW_WIDTH / 2.f) {
+            ringVelocity.x = -ringVelocity.x;
+        }
+        if (ringCenter.y < bounds.top + WINDOW_HEIGHT / 2.f ||
+            ringCenter.y > bounds.top + bounds.height - WINDOW_HEIGHT / 2.f) {
+            ringVelocity.y = -ringVelocity.y;
+        }
+        playerInstance.setCenter(ringCenter);
+        camera.setCenter(ringCenter);
+
+        // Update bullets (dropped at the view edge, like the arena's window
+        // edge, which also keeps them clear of stale far chunks)
+        for (auto it = bullets.begin(); it != bullets.end(); ) {
+            (*it)->update();
+            if ((*it)->isOutside(visibleArea())) {
+                it = bullets.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        // Update enemies
+        enemyManager.update(1.f / 60.f, world, visibleArea(), ringCenter);
+        if (world.update(nearArea(), ringCenter, ringRadius + 30.f)) { // 30.f is arbitrary
+            state = GameState::GAME_OVER;
+        }
+
+        // Check collisions
+        world.collide(bullets, [this](Enemy& enemy) { return hitEnemy(enemy); });
+    }
+
+    // Records the result after the tick that ended the game, collisions included
+    void endGame() {
+        world.clear();
+        rank = scoreStore.add(score, selectedDifficulty,
+                              static_cast<uint32_t>(playClock.getElapsedTime().asMilliseconds()),
+                              enemyManager.getSeed());
+        leaderboard = scoreStore.top(selectedDifficulty, LEADERBOARD_SIZE);
+    }
+
+    // Explosion, shake and score for a bullet hit; returns true if the enemy is destroyed
+    bool hitEnemy(Enemy& enemy) {
+        collisionsThisTick++;
+
+        // Create explosion
+        explosions.emplace_back(std::make_unique<Explosion>(enemy.getBounds().getPosition() + sf::Vector2f(enemy.getBounds().width / 2.f, enemy.getBounds().height / 2.f)));
+
+        // Screen shake
+        shakeDuration = 10;
+        shakeMagnitude = 5.f;
+
+        // Handle boss health
+        BossEnemy* boss = dynamic_cast<BossEnemy*>(&enemy);
+        if (boss) {
+            boss->takeDamage();
+            if (!boss->alive()) {
+                score += 5; // Boss gives more points
+                return true;
+            }
+            return false;
+        }
+        score += 1;
+        return true;
+    }
+
+    sf::FloatRect visibleArea() const {
+        sf::Vector2f size = camera.getSize();
+        sf::Vector2f topLeft = camera.getCenter() - size / 2.f;
+        return sf::FloatRect(topLeft.x, topLeft.y, size.x, size.y);
+    }
+
+    // Area simulated every frame: the view plus a one-chunk margin. The ring
+    // always lies inside it since the camera follows the ring.
+    sf::FloatRect nearArea() const {
+        sf::FloatRect area = visibleArea();
+        return sf::FloatRect(area.left - CHUNK_SIZE, area.top - CHUNK_SIZE,
+                             area.width + 2.f * CHUNK_SIZE, area.height + 2.f * CHUNK_SIZE);
+    }
+
     void render() {
         window.clear(COLOR_BLACK);
 
@@ -587,6 +1850,10 @@ private:
             drawMenu();
         }
         else if (state == GameState::PLAY) {
+            if (largeWorld) {
+                window.setView(camera);
+            }
+
             // Draw ring
             sf::CircleShape ring;
             ring.setRadius(ringRadius);
@@ -594,7 +1861,7 @@ private:
             ring.setOutlineThickness(2.f);
             ring.setOutlineColor(COLOR_WHITE);
             ring.setOrigin(ringRadius, ringRadius);
-            ring.setPosition(center);
+            ring.setPosition(ringCenter);
             window.draw(ring);
 
             // Draw player
@@ -609,6 +1876,9 @@ private:
             for (auto& enemy : enemies) {
                 enemy->draw(window);
             }
+            if (largeWorld) {
+                world.draw(window, visibleArea());
+            }
 
             // Draw explosions
             for (auto& explosion : explosions) {
@@ -616,6 +1886,9 @@ private:
             }
 
             // Draw score
+            if (largeWorld) {
+                window.setView(window.getDefaultView());
+            }
             sf::Text scoreText;
             scoreText.setFont(font);
             scoreText.setCharacterSize(24);
@@ -674,6 +1947,15 @@ private:
         currentDiff.setString(diffStr);
         currentDiff.setPosition(WINDOW_WIDTH / 2.f - currentDiff.getGlobalBounds().width / 2.f, 350.f);
         window.draw(currentDiff);
+
+        // Display world mode
+        sf::Text worldText;
+        worldText.setFont(font);
+        worldText.setCharacterSize(24);
+        worldText.setFillColor(COLOR_WHITE);
+        worldText.setString(largeWorld ? "World: Large (W)" : "World: Arena (W)");
+        worldText.setPosition(WINDOW_WIDTH / 2.f - worldText.getGlobalBounds().width / 2.f, 420.f);
+        window.draw(worldText);
     }
 
     void drawGameOver() {
@@ -695,6 +1977,15 @@ private:
         scoreText.setPosition(WINDOW_WIDTH / 2.f - scoreText.getGlobalBounds().width / 2.f, 250.f);
         window.draw(scoreText);
 
+        // Draw Rank
+        sf::Text rankText;
+        rankText.setFont(font);
+        rankText.setCharacterSize(24);
+        rankText.setFillColor(COLOR_YELLOW);
+        rankText.setString("Rank: #" + std::to_string(rank));
+        rankText.setPosition(WINDOW_WIDTH / 2.f - rankText.getGlobalBounds().width / 2.f, 290.f);
+        window.draw(rankText);
+
         // Draw Restart and Quit Instructions
         sf::Text restartInstr;
         restartInstr.setFont(font);
@@ -703,6 +1994,18 @@ private:
         restartInstr.setString("Press R to Restart or Q to Quit");
         restartInstr.setPosition(WINDOW_WIDTH / 2.f - restartInstr.getGlobalBounds().width / 2.f, 350.f);
         window.draw(restartInstr);
+
+        // Draw Leaderboard
+        for (size_t i = 0; i < leaderboard.size(); i++) {
+            sf::Text entryText;
+            entryText.setFont(font);
+            entryText.setCharacterSize(20);
+            entryText.setFillColor(COLOR_WHITE);
+            entryText.setString(std::to_string(i + 1) + ". " + std::to_string(leaderboard[i].score) +
+                                "  (" + std::to_string(leaderboard[i].durationMs / 1000) + "s)");
+            entryText.setPosition(WINDOW_WIDTH / 2.f - entryText.getGlobalBounds().width / 2.f, 410.f + i * 28.f);
+            window.draw(entryText);
+        }
     }
 };
 